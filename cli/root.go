@@ -43,6 +43,7 @@ func init() {
 	Root.RegisterCMD(&cmd.Help)
 	Root.RegisterCMD(&Run)
 	Root.RegisterCMD(&List)
+	Root.RegisterCMD(&State)
 	Root.RegisterCMD(&Version)
 
 	//Set up logging
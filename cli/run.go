@@ -36,8 +36,10 @@ var Run = cmd.CMD{
 
 // RunFlags contains the additional flags for the "run" subcommand
 type RunFlags struct {
-	Force  bool `short:"f" long:"force"   desc:"Force run the configuration regardless if it should be skipped."`
-	DryRun bool `short:"n" long:"dry-run" desc:"Test the configuration files without executing the specified binaries and arguments"`
+	Force    bool `short:"f" long:"force"     desc:"Force run the configuration regardless if it should be skipped."`
+	DryRun   bool `short:"n" long:"dry-run"   desc:"Test the configuration files without executing the specified binaries and arguments"`
+	FullScan bool `short:"F" long:"full-scan" desc:"Check the merged view of an overlayfs root instead of only its upper layer"`
+	Dirty    bool `short:"D" long:"dirty"     desc:"Only run the triggers stamped in the dirty directory"`
 }
 
 // RunArgs contains the arguments for the "run" subcommand
@@ -74,6 +76,12 @@ func RunRun(r *cmd.RootCMD, c *cmd.CMD) {
 		gFlags.Live = true
 	}
 
+	// Limit change detection to the overlayfs upper layer as needed
+	var upper string
+	if !flags.FullScan {
+		upper, _ = util.OverlayUpperDir()
+	}
+
 	// Load Triggers
 	tm, err := config.LoadAll()
 	if err != nil {
@@ -95,6 +103,12 @@ func RunRun(r *cmd.RootCMD, c *cmd.CMD) {
 		DryRun: flags.DryRun,
 		Forced: flags.Force,
 		Live:   gFlags.Live,
+		Upper:  upper,
+	}
+	// Run stamped triggers
+	if flags.Dirty {
+		triggers.RunStamped(tm, s, config.DirtyDir)
+		return
 	}
 	// Run triggers
 	triggers.Run(tm, s, n)
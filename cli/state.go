@@ -0,0 +1,90 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package cli
+
+import (
+	"github.com/DataDrake/cli-ng/cmd"
+	log "github.com/DataDrake/waterlog"
+	"github.com/DataDrake/waterlog/level"
+	"github.com/getsolus/usysconf/state"
+	"path/filepath"
+)
+
+// State fulfills the "state" subcommand
+var State = cmd.CMD{
+	Name:  "state",
+	Alias: "st",
+	Short: "Export or import a portable snapshot of the trigger state (e.g. for image builds)",
+	Flags: &StateFlags{},
+	Args:  &StateArgs{},
+	Run:   StateRun,
+}
+
+// StateFlags contains the additional flags for the "state" subcommand
+type StateFlags struct {
+	Root string `short:"r" long:"root" desc:"Root directory of the system to export from or import into"`
+}
+
+// StateArgs contains the arguments for the "state" subcommand
+type StateArgs struct {
+	Action string `desc:"Either 'export' or 'import'"`
+	File   string `desc:"Location of the snapshot file"`
+}
+
+// StateRun exports or imports a state snapshot
+func StateRun(r *cmd.RootCMD, c *cmd.CMD) {
+	gFlags := r.Flags.(*GlobalFlags)
+	args := c.Args.(*StateArgs)
+	flags := c.Flags.(*StateFlags)
+
+	// Enable Debug Output
+	if gFlags.Debug {
+		log.SetLevel(level.Debug)
+	}
+
+	root := flags.Root
+	if len(root) == 0 {
+		root = "/"
+	}
+	path := filepath.Join(root, state.Path)
+
+	switch args.Action {
+	case "export":
+		m, err := state.LoadFile(path)
+		if err != nil {
+			log.Warnf("Exporting what could be read, reason: %s\n", err)
+		}
+		snap := m.Export(root)
+		if err := snap.Save(args.File); err != nil {
+			log.Fatalf("Failed to export state, reason: %s\n", err)
+		}
+		log.Goodf("Exported '%d' paths to '%s'\n", len(snap), args.File)
+	case "import":
+		snap, err := state.LoadSnapshot(args.File)
+		if err != nil {
+			log.Fatalf("Failed to read state snapshot, reason: %s\n", err)
+		}
+		// The state file is rewritten in full, so any damage is replaced
+		m, _ := state.LoadFile(path)
+		valid := snap.Import(root)
+		m.Merge(valid)
+		if err = m.SaveFile(path); err != nil {
+			log.Fatalf("Failed to save state file, reason: %s\n", err)
+		}
+		log.Goodf("Imported '%d' of '%d' paths from '%s'\n", len(valid), len(snap), args.File)
+	default:
+		log.Fatalf("Unknown state action '%s', expected 'export' or 'import'\n", args.Action)
+	}
+}
@@ -15,6 +15,7 @@
 package config
 
 import (
+	"errors"
 	"fmt"
 	wlog "github.com/DataDrake/waterlog"
 	"github.com/getsolus/usysconf/triggers"
@@ -25,24 +26,45 @@ import (
 	"strings"
 )
 
+// LoadTrigger reads in and validates a single trigger file
+func LoadTrigger(path string) (t triggers.Trigger, err error) {
+	t = triggers.Trigger{
+		Name: strings.TrimSuffix(filepath.Base(path), ".toml"),
+		Path: filepath.Clean(path),
+	}
+	if err = t.Load(t.Path); err == nil {
+		// Check the config for problems
+		err = t.Validate()
+	}
+	return
+}
+
 // Load reads in all of the trigger files in a directory
 func Load(path string) (tm triggers.Map, err error) {
+	return load(path, triggers.Logged)
+}
+
+// load reads in all of the trigger files in a directory, reporting through h
+func load(path string, h triggers.Hooks) (tm triggers.Map, err error) {
+	if h.Debug == nil {
+		h.Debug = func(string) {}
+	}
 	tm = make(triggers.Map)
 	entries, err := ioutil.ReadDir(path)
 	if err != nil {
-		wlog.Debugf("Skipped directory '%s':\n", path)
+		h.Debug(fmt.Sprintf("Skipped directory '%s':", path))
 	}
 	if os.IsNotExist(err) {
-		wlog.Debugf("    Not found.\n")
+		h.Debug("    Not found.")
 		err = nil
 		return
 	}
 	if err != nil {
-		wlog.Debugf("    Failed to read triggers, reason: %s\n", err)
+		h.Debug(fmt.Sprintf("    Failed to read triggers, reason: %s", err))
 		err = nil
 		return
 	}
-	wlog.Debugf("Scanning directory '%s':\n", path)
+	h.Debug(fmt.Sprintf("Scanning directory '%s':", path))
 	found := false
 	for _, entry := range entries {
 		if entry.IsDir() {
@@ -52,18 +74,11 @@ func Load(path string) (tm triggers.Map, err error) {
 		if !strings.HasSuffix(name, ".toml") {
 			continue
 		}
-		t := triggers.Trigger{
-			Name: strings.TrimSuffix(name, ".toml"),
-			Path: filepath.Clean(filepath.Join(path, name)),
-		}
 		// found trigger
-		wlog.Debugf("    Found '%s'\n", t.Name)
+		h.Debug(fmt.Sprintf("    Found '%s'", strings.TrimSuffix(name, ".toml")))
 		found = true
-		if err = t.Load(t.Path); err == nil {
-			// Check the config for problems
-			err = t.Validate()
-		}
-		if err != nil {
+		var t triggers.Trigger
+		if t, err = LoadTrigger(filepath.Join(path, name)); err != nil {
 			err = fmt.Errorf("failed to read '%s' from '%s' reason: %s", name, path, err.Error())
 			return
 		}
@@ -71,7 +86,21 @@ func Load(path string) (tm triggers.Map, err error) {
 		tm[t.Name] = t
 	}
 	if !found {
-		wlog.Debugln("    No triggers found.")
+		h.Debug("    No triggers found.")
+	}
+	return
+}
+
+// LoadDirs reads in the triggers from several directories, in order, where later
+// triggers replace earlier ones with the same name. Details are reported through h.
+func LoadDirs(h triggers.Hooks, paths ...string) (tm triggers.Map, err error) {
+	tm = make(triggers.Map)
+	var tm2 triggers.Map
+	for _, path := range paths {
+		if tm2, err = load(path, h); err != nil {
+			return
+		}
+		triggers.Merge(tm, tm2)
 	}
 	return
 }
@@ -80,17 +109,12 @@ func Load(path string) (tm triggers.Map, err error) {
 // configuration file that has the passed name parameter, without the extension
 // and will create a config with the specified valus.
 func LoadAll() (tm triggers.Map, err error) {
-	// Read from System directory
-	tm, err = Load(SysDir)
+	var tm2 triggers.Map
+	// Read from System and User directories
+	tm, err = LoadDirs(triggers.Logged, SysDir, UsrDir)
 	if err != nil {
 		return
 	}
-	// Read from User Directory
-	tm2, err := Load(UsrDir)
-	if err != nil {
-		return
-	}
-	triggers.Merge(tm, tm2)
 
 	// Read from Home directory
 	home, err := os.UserHomeDir()
@@ -125,7 +149,8 @@ func LoadAll() (tm triggers.Map, err error) {
 CHECK:
 	// check for lack of triggers
 	if len(tm) == 0 {
-		wlog.Fatalln("No triggers available")
+		err = errors.New("no triggers available")
+		return
 	}
 	wlog.Goodf("Found '%d' triggers\n", len(tm))
 	return
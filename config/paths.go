@@ -19,4 +19,6 @@ var (
 	UsrDir string
 	// SysDir is the path defined during build (Makefile) i.e. /etc/usysconf.d
 	SysDir string
+	// DirtyDir is the path defined during build (Makefile) i.e. /run/usysconf/dirty
+	DirtyDir string
 )
@@ -0,0 +1,187 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Package engine runs usysconf triggers from within other Go programs, keeping the
+// triggers and state loaded between runs. It never exits the process, and reports
+// through return values and callbacks instead of logging.
+package engine
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"github.com/getsolus/usysconf/config"
+	"github.com/getsolus/usysconf/state"
+	"github.com/getsolus/usysconf/triggers"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+)
+
+// Result is the outcome of a single trigger
+type Result struct {
+	Name   string
+	Status triggers.Status
+	Output []triggers.Output
+}
+
+// Options configure where an Engine finds its triggers and state
+type Options struct {
+	// Dirs are read for triggers in order, where later triggers replace earlier
+	// ones with the same name (e.g. /usr/share/defaults/usysconf.d, /etc/usysconf.d)
+	Dirs []string
+	// StatePath is the file the state is loaded from and saved to
+	StatePath string
+	// Scope sets the limits of execution for every run
+	Scope triggers.Scope
+
+	// OnWarn receives problems which do not stop a run, if set
+	OnWarn func(msg string)
+	// OnDebug receives details of loading and running triggers, if set. It may be
+	// called from several goroutines at once.
+	OnDebug func(msg string)
+	// OnResult receives each Result as soon as its trigger finishes, if set
+	OnResult func(r Result)
+}
+
+// Engine holds the loaded triggers and state for repeated runs. It is safe to use
+// from several goroutines, but runs are carried out one at a time.
+type Engine struct {
+	triggers triggers.Map
+	state    state.Map
+	opts     Options
+	damaged  bool
+	lock     sync.Mutex
+}
+
+// New creates an Engine with the triggers from the given directories and the
+// last saved state. Finding no triggers at all is an error.
+func New(o Options) (e *Engine, err error) {
+	if len(o.Dirs) == 0 {
+		err = errors.New("no trigger directories given")
+		return
+	}
+	if len(o.StatePath) == 0 {
+		err = errors.New("no state path given")
+		return
+	}
+	tm, err := config.LoadDirs(triggers.Hooks{Warn: o.OnWarn, Debug: o.OnDebug}, o.Dirs...)
+	if err != nil {
+		return
+	}
+	if len(tm) == 0 {
+		err = fmt.Errorf("no triggers found in %v", o.Dirs)
+		return
+	}
+	// A damaged state file is replaced on the first run, instead of updated
+	m, serr := state.LoadFile(o.StatePath)
+	e = &Engine{
+		triggers: tm,
+		state:    m,
+		opts:     o,
+		damaged:  serr != nil,
+	}
+	return
+}
+
+// Triggers gets a copy of the loaded triggers
+func (e *Engine) Triggers() triggers.Map {
+	e.lock.Lock()
+	defer e.lock.Unlock()
+	tm := make(triggers.Map)
+	triggers.Merge(tm, e.triggers)
+	return tm
+}
+
+// State gets a copy of the current state
+func (e *Engine) State() state.Map {
+	e.lock.Lock()
+	defer e.lock.Unlock()
+	m := make(state.Map)
+	m.Merge(e.state)
+	return m
+}
+
+// Scope gets the limits of execution used for every run
+func (e *Engine) Scope() triggers.Scope {
+	return e.opts.Scope
+}
+
+// Run processes the requested triggers, or all of them if none are given. Each
+// target is either the name of a loaded trigger or the path to a trigger file.
+// Unless this is a dry-run, the state is saved afterwards.
+func (e *Engine) Run(ctx context.Context, targets ...string) (results []Result, err error) {
+	e.lock.Lock()
+	defer e.lock.Unlock()
+	tm, copied := e.triggers, false
+	names := make([]string, 0, len(targets))
+	for _, target := range targets {
+		if !strings.HasSuffix(target, ".toml") && !strings.ContainsRune(target, filepath.Separator) {
+			names = append(names, target)
+			continue
+		}
+		// Load triggers from files without modifying the Engine
+		if !copied {
+			tm = make(triggers.Map)
+			triggers.Merge(tm, e.triggers)
+			copied = true
+		}
+		var t triggers.Trigger
+		if t, err = config.LoadTrigger(target); err != nil {
+			err = fmt.Errorf("failed to load trigger '%s', reason: %s", target, err)
+			return
+		}
+		tm[t.Name] = t
+		names = append(names, t.Name)
+	}
+	if len(names) == 0 {
+		for name := range tm {
+			names = append(names, name)
+		}
+		sort.Strings(names)
+	}
+	h := triggers.Hooks{
+		Warn:  e.opts.OnWarn,
+		Debug: e.opts.OnDebug,
+		Done: func(t triggers.Trigger) {
+			r := Result{
+				Name:   t.Name,
+				Status: t.Status(),
+				Output: t.Output,
+			}
+			results = append(results, r)
+			if e.opts.OnResult != nil {
+				e.opts.OnResult(r)
+			}
+		},
+	}
+	next, err := triggers.Process(ctx, tm, e.opts.Scope, e.state, names, h)
+	if e.opts.Scope.DryRun {
+		return
+	}
+	// Keep whatever was processed, even if cancelled
+	e.state.Merge(next)
+	var serr error
+	if e.damaged {
+		serr = e.state.SaveFile(e.opts.StatePath)
+		e.damaged = serr != nil
+	} else {
+		serr = e.state.UpdateFile(e.opts.StatePath, next)
+	}
+	if serr != nil && err == nil {
+		err = fmt.Errorf("failed to save state, reason: %s", serr)
+	}
+	return
+}
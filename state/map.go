@@ -16,46 +16,153 @@ package state
 
 import (
 	"fmt"
-	log "github.com/DataDrake/waterlog"
 	cbor "github.com/fxamacker/cbor/v2"
+	"io"
+	"io/ioutil"
 	"os"
 	"path/filepath"
 	"regexp"
 	"strings"
+	"syscall"
 	"time"
 )
 
 // Path is the location of the serialized system state directory
 var Path string
 
+// encoding keeps the full precision of modification times, so that unchanged
+// paths compare as equal after reloading the state
+var encoding, _ = cbor.EncOptions{Time: cbor.TimeRFC3339Nano}.EncMode()
+
 // Map contains a list files and their modification times
 type Map map[string]time.Time
 
 // Load reads in the state if it exists and deserializes it
-func Load() Map {
-	m := make(Map)
-	sFile, err := os.Open(filepath.Clean(Path))
+func Load() (Map, error) {
+	return LoadFile(Path)
+}
+
+// LoadFile reads in the state from a specific file, if it exists. The file holds a
+// full record of the state, followed by any records of changes appended since.
+// If a record is damaged (e.g. by an interrupted write), whatever came before it is
+// returned with an error, and the file should be replaced rather than updated.
+func LoadFile(path string) (m Map, err error) {
+	m = make(Map)
+	sFile, err := os.Open(filepath.Clean(path))
 	if err != nil {
-		return m
+		err = nil
+		return
 	}
 	dec := cbor.NewDecoder(sFile)
-	_ = dec.Decode(m)
+	for {
+		record := make(Map)
+		if err = dec.Decode(&record); err != nil {
+			break
+		}
+		m.Merge(record)
+	}
 	_ = sFile.Close()
-	return m
+	if err == io.EOF {
+		err = nil
+	} else {
+		err = fmt.Errorf("damaged state file '%s': %s", path, err)
+	}
+	return
 }
 
 // Save writes out the current state for future runs
 func (m Map) Save() error {
-	if err := os.MkdirAll(filepath.Dir(Path), 0750); err != nil {
+	return m.SaveFile(Path)
+}
+
+// SaveFile replaces the state in a specific file
+func (m Map) SaveFile(path string) error {
+	raw, err := encoding.Marshal(m)
+	if err != nil {
 		return err
 	}
-	sFile, err := os.Create(filepath.Clean(Path))
+	return replace(path, raw)
+}
+
+// Update records the changes in delta, which have already been merged into the
+// Map, without writing anything if there are none. The changes are appended to
+// the state file, until the appended records outgrow the full state and the file
+// is rewritten instead.
+func (m Map) Update(delta Map) error {
+	return m.UpdateFile(Path, delta)
+}
+
+// UpdateFile works like Update, for a specific state file
+func (m Map) UpdateFile(path string, delta Map) error {
+	if delta.IsEmpty() {
+		return nil
+	}
+	full, err := encoding.Marshal(m)
 	if err != nil {
 		return err
 	}
-	enc := cbor.NewEncoder(sFile)
-	err = enc.Encode(m)
-	_ = sFile.Close()
+	info, err := os.Stat(filepath.Clean(path))
+	if err != nil {
+		return replace(path, full)
+	}
+	raw, err := encoding.Marshal(delta)
+	if err != nil {
+		return err
+	}
+	if info.Size()+int64(len(raw)) > 2*int64(len(full)) {
+		return replace(path, full)
+	}
+	sFile, err := os.OpenFile(filepath.Clean(path), os.O_WRONLY|os.O_APPEND, 0)
+	if err != nil {
+		return err
+	}
+	_, err = sFile.Write(raw)
+	if cerr := sFile.Close(); err == nil {
+		err = cerr
+	}
+	return err
+}
+
+// replace atomically swaps the contents of a file for new ones
+func replace(path string, raw []byte) error {
+	path = filepath.Clean(path)
+	dir := filepath.Dir(path)
+	if err := os.MkdirAll(dir, 0750); err != nil {
+		return err
+	}
+	// Same directory, so the rename cannot cross filesystems
+	sFile, err := ioutil.TempFile(dir, "."+filepath.Base(path)+".")
+	if err != nil {
+		return err
+	}
+	tmp := sFile.Name()
+	_, err = sFile.Write(raw)
+	if err == nil {
+		err = sFile.Chmod(0644)
+	}
+	if err == nil {
+		// Make sure the contents are on disk before they replace the old ones
+		err = sFile.Sync()
+	}
+	if cerr := sFile.Close(); err == nil {
+		err = cerr
+	}
+	if err == nil {
+		err = os.Rename(tmp, path)
+	}
+	if err != nil {
+		_ = os.Remove(tmp)
+		return err
+	}
+	// Make sure the rename itself is on disk
+	dFile, err := os.Open(dir)
+	if err != nil {
+		return err
+	}
+	err = dFile.Sync()
+	if cerr := dFile.Close(); err == nil {
+		err = cerr
+	}
 	return err
 }
 
@@ -88,16 +195,26 @@ func Diff(old, curr Map) Map {
 	return diff
 }
 
-// Search finds all of the matching files in a Map
+// SearchRegexp converts a path, where "*" matches anything, to the regex used by Search
+func SearchRegexp(path string) (*regexp.Regexp, error) {
+	search := path
+	search = strings.ReplaceAll(search, "*", ".*")
+	search = "^" + strings.ReplaceAll(search, string(filepath.Separator), "\\"+string(filepath.Separator))
+	return regexp.Compile(search)
+}
+
+// ExcludeRegexp converts a pattern, where "*" matches anything, to the regex used by Exclude
+func ExcludeRegexp(pattern string) (*regexp.Regexp, error) {
+	return regexp.Compile(strings.ReplaceAll(pattern, "*", ".*"))
+}
+
+// Search finds all of the matching files in a Map, ignoring paths which are not
+// valid regexes (see SearchRegexp)
 func (m Map) Search(paths []string) Map {
 	match := make(Map)
 	for _, path := range paths {
-		search := path
-		search = strings.ReplaceAll(search, "*", ".*")
-		search = "^" + strings.ReplaceAll(search, string(filepath.Separator), "\\"+string(filepath.Separator))
-		regex, err := regexp.Compile(search)
+		regex, err := SearchRegexp(path)
 		if err != nil {
-			log.Warnf("Could not convert path to regex: %s\n", path)
 			continue
 		}
 		for k, v := range m {
@@ -109,16 +226,14 @@ func (m Map) Search(paths []string) Map {
 	return match
 }
 
-// Exclude removes keys from the Map if they match certain patterns
+// Exclude removes keys from the Map if they match certain patterns, ignoring
+// patterns which are not valid regexes (see ExcludeRegexp)
 func (m Map) Exclude(patterns []string) Map {
 	match := make(Map)
 	var regexes []*regexp.Regexp
 	for _, pattern := range patterns {
-		exclude := pattern
-		exclude = strings.ReplaceAll(exclude, "*", ".*")
-		regex, err := regexp.Compile(exclude)
+		regex, err := ExcludeRegexp(pattern)
 		if err != nil {
-			log.Warnf("Could not convert pattern to regex: %s\n", pattern)
 			continue
 		}
 		regexes = append(regexes, regex)
@@ -180,3 +295,61 @@ func Scan(paths []string) (m Map, err error) {
 	}
 	return
 }
+
+// ScanLayer works like Scan, but only looks for the paths within an overlayfs
+// upper layer. Anything missing from the layer is unchanged from the lower
+// layers, so it is left out of the Map entirely. Keys are the merged paths.
+func ScanLayer(upper string, paths []string) (m Map, err error) {
+	m = make(Map)
+	var p []string
+	for _, path := range paths {
+		p, err = filepath.Glob(filepath.Join(escapeGlob(upper), path))
+		if err != nil {
+			err = fmt.Errorf("unable to glob path: %s", path)
+			return
+		}
+		var info os.FileInfo
+		for _, pa := range p {
+			rel, _ := filepath.Rel(upper, pa)
+			merged := filepath.Join(string(filepath.Separator), rel)
+			info, err = os.Lstat(filepath.Clean(pa))
+			// Whiteouts are kept, since a deletion is a modification too
+			if err == nil && !isWhiteout(info) {
+				// Stat the merged path, as Scan would, so symlinks resolve the same
+				info, err = os.Stat(merged)
+			}
+			if err != nil {
+				if os.IsNotExist(err) {
+					err = nil
+					continue
+				}
+				err = fmt.Errorf("failed to check path: %s", pa)
+				return
+			}
+			m[merged] = info.ModTime()
+		}
+	}
+	return
+}
+
+// isWhiteout checks if a file in an overlayfs upper layer marks a deletion
+func isWhiteout(info os.FileInfo) bool {
+	if info.Mode()&os.ModeCharDevice == 0 {
+		return false
+	}
+	sys, ok := info.Sys().(*syscall.Stat_t)
+	return ok && sys.Rdev == 0
+}
+
+// escapeGlob keeps the special characters of a literal path from being globbed
+func escapeGlob(path string) string {
+	var escaped strings.Builder
+	for _, c := range path {
+		switch c {
+		case '*', '?', '[', '\\':
+			escaped.WriteRune('\\')
+		}
+		escaped.WriteRune(c)
+	}
+	return escaped.String()
+}
@@ -0,0 +1,104 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package state
+
+import (
+	cbor "github.com/fxamacker/cbor/v2"
+	"os"
+	"path/filepath"
+	"strings"
+	"syscall"
+	"time"
+)
+
+// Identity is the stat information used to recognize a path on another system
+type Identity struct {
+	Ino   uint64
+	Size  int64
+	MTime time.Time
+}
+
+// Snapshot is a portable copy of a Map, with paths relative to the root
+type Snapshot map[string]Identity
+
+// stat gets the Identity of a path
+func stat(path string) (id Identity, err error) {
+	info, err := os.Stat(filepath.Clean(path))
+	if err != nil {
+		return
+	}
+	id.Size = info.Size()
+	id.MTime = info.ModTime()
+	if sys, ok := info.Sys().(*syscall.Stat_t); ok {
+		id.Ino = uint64(sys.Ino)
+	}
+	return
+}
+
+// Export creates a Snapshot of the paths in the Map, as found under root. Paths
+// which have been modified since they were recorded are left out.
+func (m Map) Export(root string) Snapshot {
+	snap := make(Snapshot)
+	for k, v := range m {
+		id, err := stat(filepath.Join(root, k))
+		if err != nil || !id.MTime.Equal(v) {
+			continue
+		}
+		snap[strings.TrimPrefix(filepath.Clean(k), string(filepath.Separator))] = id
+	}
+	return snap
+}
+
+// Import converts a Snapshot back into a Map for the paths under root, keeping
+// only the paths which still match their size and modification time. Inodes are
+// kept for reference but not compared, since they rarely survive copying an image.
+func (snap Snapshot) Import(root string) Map {
+	m := make(Map)
+	for k, v := range snap {
+		id, err := stat(filepath.Join(root, k))
+		if err != nil || id.Size != v.Size || !id.MTime.Equal(v.MTime) {
+			continue
+		}
+		m[filepath.Join(string(filepath.Separator), k)] = v.MTime
+	}
+	return m
+}
+
+// LoadSnapshot reads in a Snapshot from a file
+func LoadSnapshot(path string) (snap Snapshot, err error) {
+	snap = make(Snapshot)
+	sFile, err := os.Open(filepath.Clean(path))
+	if err != nil {
+		return
+	}
+	dec := cbor.NewDecoder(sFile)
+	err = dec.Decode(&snap)
+	_ = sFile.Close()
+	return
+}
+
+// Save writes out the Snapshot to a file
+func (snap Snapshot) Save(path string) error {
+	sFile, err := os.Create(filepath.Clean(path))
+	if err != nil {
+		return err
+	}
+	enc := encoding.NewEncoder(sFile)
+	err = enc.Encode(snap)
+	if cerr := sFile.Close(); err == nil {
+		err = cerr
+	}
+	return err
+}
@@ -17,9 +17,9 @@ package triggers
 import (
 	"bytes"
 	"fmt"
-	log "github.com/DataDrake/waterlog"
 	"github.com/getsolus/usysconf/util"
 	"os/exec"
+	"runtime"
 )
 
 // Bin contains the details of the binary to be executed.
@@ -31,22 +31,43 @@ type Bin struct {
 }
 
 // ExecuteBins generates and runs all of the necesarry Bin commands
-func (t *Trigger) ExecuteBins(s Scope) {
-	var bins []Bin
-	var outputs []Output
-	// Generate
+func (t *Trigger) ExecuteBins(s Scope, h Hooks) {
+	// Each [[bins]] entry runs in order, since later ones may rely on earlier ones
 	for _, b := range t.Bins {
-		bs, outs := b.FanOut()
-		bins = append(bins, bs...)
-		outputs = append(outputs, outs...)
+		// Generate
+		bins, outputs := b.FanOut(h)
+		// Execute
+		results, err := t.executeFanOut(s, bins, h)
+		for i, out := range results {
+			outputs[i].Status = out.Status
+			outputs[i].Message = out.Message
+		}
+		if err != nil {
+			out := Output{
+				Status:  Failure,
+				Message: fmt.Sprintf("Failed to supervise bins for '%s', reason: %s\n", t.Name, err),
+			}
+			outputs = append(outputs, out)
+		}
+		t.Output = append(t.Output, outputs...)
+	}
+}
+
+// executeFanOut runs the bins fanned out from a single Bin concurrently through
+// Supervise, falling back to running them one at a time when that isn't possible.
+func (t *Trigger) executeFanOut(s Scope, bins []Bin, h Hooks) (outs []Output, err error) {
+	if !s.DryRun && len(bins) > 1 {
+		outs, err = Supervise(bins, t.Env, runtime.NumCPU())
+		if outs != nil {
+			return
+		}
+		h.debug(fmt.Sprintf("    Running bins one at a time, reason: %s", err))
+		err = nil
 	}
-	// Execute
-	for i, b := range bins {
-		out := b.Execute(s, t.Env)
-		outputs[i].Status = out.Status
-		outputs[i].Message = out.Message
+	for _, b := range bins {
+		outs = append(outs, b.Execute(s, t.Env))
 	}
-	t.Output = append(t.Output, outputs...)
+	return
 }
 
 // Execute the binary from the confuration
@@ -77,7 +98,7 @@ func (b *Bin) Execute(s Scope, env map[string]string) Output {
 
 // FanOut generates one or more bin tasks from a given, as needed by replacing the "***" sequence
 // in the arguments and creating separate binaries to be executed.
-func (b Bin) FanOut() (nbins []Bin, outputs []Output) {
+func (b Bin) FanOut(h Hooks) (nbins []Bin, outputs []Output) {
 
 	r := b.Replace
 
@@ -102,7 +123,7 @@ func (b Bin) FanOut() (nbins []Bin, outputs []Output) {
 		return
 	}
 
-	log.Debugf("    Replace string exists at arg: %d\n", phIndex)
+	h.debug(fmt.Sprintf("    Replace string exists at arg: %d", phIndex))
 
 	paths := util.FilterPaths(r.Paths, r.Exclude)
 	for _, p := range paths {
@@ -110,8 +131,10 @@ func (b Bin) FanOut() (nbins []Bin, outputs []Output) {
 			Name:    b.Task,
 			SubTask: p,
 		}
-		b.Args[phIndex] = p
-		nbins = append(nbins, b)
+		nb := b
+		nb.Args = append([]string(nil), b.Args...)
+		nb.Args[phIndex] = p
+		nbins = append(nbins, nb)
 		outputs = append(outputs, out)
 	}
 	return
@@ -17,7 +17,6 @@ package triggers
 import (
 	"fmt"
 	"github.com/getsolus/usysconf/state"
-	log "github.com/DataDrake/waterlog"
 )
 
 // Check contains paths that must exixt to execute the configuration.  This
@@ -27,13 +26,20 @@ type Check struct {
 }
 
 // CheckMatch will glob the paths and if the path does not exist in the system, an error is returned
-func (t *Trigger) CheckMatch() (m state.Map, ok bool) {
+//
+// When running on an overlayfs root, only the upper layer is scanned.
+func (t *Trigger) CheckMatch(s Scope, h Hooks) (m state.Map, ok bool) {
 	if t.Check == nil {
-		log.Debugf("No check paths for trigger '%s'\n", t.Name)
+		h.debug(fmt.Sprintf("No check paths for trigger '%s'", t.Name))
 		ok = true
 		return
 	}
-	m, err := state.Scan(t.Check.Paths)
+	var err error
+	if len(s.Upper) > 0 {
+		m, err = state.ScanLayer(s.Upper, t.Check.Paths)
+	} else {
+		m, err = state.Scan(t.Check.Paths)
+	}
 	if err != nil {
 		out := Output{
 			Status:  Failure,
@@ -17,6 +17,7 @@ package triggers
 import (
 	"fmt"
 	"github.com/BurntSushi/toml"
+	"github.com/getsolus/usysconf/state"
 	"io/ioutil"
 	"os"
 	"path/filepath"
@@ -49,5 +50,20 @@ func (t *Trigger) Validate() error {
 	if len(t.Bins) == 0 {
 		return fmt.Errorf("triggers must contain at least one [[bin]]")
 	}
+	// Patterns which cannot be matched would otherwise be ignored when running
+	if t.Skip != nil {
+		for _, path := range t.Skip.Paths {
+			if _, err := state.SearchRegexp(path); err != nil {
+				return fmt.Errorf("invalid skip path '%s', reason: %s", path, err)
+			}
+		}
+	}
+	if t.RemoveDirs != nil {
+		for _, pattern := range t.RemoveDirs.Exclude {
+			if _, err := state.ExcludeRegexp(pattern); err != nil {
+				return fmt.Errorf("invalid remove exclude '%s', reason: %s", pattern, err)
+			}
+		}
+	}
 	return nil
 }
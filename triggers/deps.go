@@ -0,0 +1,99 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package triggers
+
+import (
+	"fmt"
+	"github.com/getsolus/usysconf/state"
+)
+
+const (
+	unvisited = iota
+	visiting
+	visited
+)
+
+// Sort orders a list of trigger names so that requested dependencies come before
+// the triggers which need them. Missing dependencies and cycles warn, but do not fail.
+func Sort(tm Map, names []string, h Hooks) (sorted []string) {
+	requested := make(map[string]bool)
+	for _, name := range names {
+		requested[name] = true
+	}
+	marks := make(map[string]int)
+	var visit func(name string)
+	visit = func(name string) {
+		switch marks[name] {
+		case visiting:
+			h.warn(fmt.Sprintf("Dependency cycle found at trigger '%s'", name))
+			return
+		case visited:
+			return
+		}
+		marks[name] = visiting
+		if t, ok := tm[name]; ok {
+			for _, dep := range t.Deps {
+				if _, ok := tm[dep]; !ok {
+					h.warn(fmt.Sprintf("Could not find dependency '%s' for trigger '%s'", dep, name))
+					continue
+				}
+				if requested[dep] {
+					visit(dep)
+				}
+			}
+		}
+		marks[name] = visited
+		sorted = append(sorted, name)
+	}
+	for _, name := range names {
+		visit(name)
+	}
+	return
+}
+
+// Refresh repeats detection for a Decision once its dependencies have executed,
+// since they may have modified its check paths. Dependencies which left their
+// produced files byte-identical are cut off: a produced path doesn't count as a
+// change if this trigger had already recorded the version from before executing.
+func (d *Decision) Refresh(s Scope, prev state.Map, outcomes map[string]Outcome, h Hooks) {
+	var cutoff []string
+	clean := make(state.Map)
+	executed := false
+	for _, dep := range d.Trigger.Deps {
+		o, ok := outcomes[dep]
+		if !ok {
+			continue
+		}
+		executed = true
+		if !o.Changed {
+			cutoff = append(cutoff, dep)
+			clean.Merge(o.Before)
+		}
+	}
+	if !executed {
+		return
+	}
+	t := d.Trigger
+	t.Output = nil
+	d.Diff, d.Cut, d.Run, _ = t.detect(s, prev, clean, h)
+	if !d.Run && len(cutoff) > 0 {
+		out := Output{
+			Status:  Skipped,
+			Message: fmt.Sprintf("outputs of %v unchanged", cutoff),
+		}
+		t.Output = append(t.Output, out)
+	}
+	d.Trigger = t
+}
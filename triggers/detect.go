@@ -0,0 +1,63 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package triggers
+
+import (
+	"fmt"
+	"github.com/getsolus/usysconf/state"
+	"sync"
+)
+
+// Decision is the outcome of change detection for a single Trigger
+type Decision struct {
+	Trigger Trigger
+	Diff    state.Map
+	// Cut holds the part of Diff which was ignored by early cutoff
+	Cut state.Map
+	Run bool
+}
+
+// Detect checks all of the requested triggers concurrently, since detection only
+// reads from the filesystem. Decisions keep the order of names, leaving out any
+// triggers which could not be found.
+func Detect(tm Map, s Scope, prev state.Map, names []string, h Hooks) []Decision {
+	found := make([]bool, len(names))
+	decisions := make([]Decision, len(names))
+	var wg sync.WaitGroup
+	for i, name := range names {
+		// Get Trigger if available
+		t, ok := tm[name]
+		if !ok {
+			h.warn(fmt.Sprintf("Could not find trigger %s", name))
+			continue
+		}
+		found[i] = true
+		decisions[i].Trigger = t
+		wg.Add(1)
+		go func(d *Decision) {
+			defer wg.Done()
+			d.Diff, d.Run, _ = d.Trigger.Detect(s, prev, h)
+		}(&decisions[i])
+	}
+	wg.Wait()
+	// Drop the missing triggers
+	var ds []Decision
+	for i, d := range decisions {
+		if found[i] {
+			ds = append(ds, d)
+		}
+	}
+	return ds
+}
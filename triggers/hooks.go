@@ -0,0 +1,61 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package triggers
+
+import (
+	log "github.com/DataDrake/waterlog"
+)
+
+// Logged reports warnings and details through the log, as the CLI does
+var Logged = Hooks{
+	Warn: func(msg string) {
+		log.Warnln(msg)
+	},
+	Debug: func(msg string) {
+		log.Debugln(msg)
+	},
+}
+
+// Hooks are called as triggers are processed, in place of logging. Debug may be
+// called from several goroutines at once during detection.
+type Hooks struct {
+	// Warn reports problems which do not stop processing (e.g. missing triggers)
+	Warn func(msg string)
+	// Debug reports details of what is being done
+	Debug func(msg string)
+	// Done receives each trigger once it has been skipped or executed
+	Done func(t Trigger)
+}
+
+// warn calls the Warn hook, if set
+func (h Hooks) warn(msg string) {
+	if h.Warn != nil {
+		h.Warn(msg)
+	}
+}
+
+// debug calls the Debug hook, if set
+func (h Hooks) debug(msg string) {
+	if h.Debug != nil {
+		h.Debug(msg)
+	}
+}
+
+// done calls the Done hook, if set
+func (h Hooks) done(t Trigger) {
+	if h.Done != nil {
+		h.Done(t)
+	}
+}
@@ -15,6 +15,7 @@
 package triggers
 
 import (
+	"context"
 	"fmt"
 	log "github.com/DataDrake/waterlog"
 	"github.com/getsolus/usysconf/state"
@@ -54,23 +55,70 @@ func Print(tm Map) {
 
 // Run executes a list of triggers, where available
 func Run(tm Map, s Scope, names []string) {
-	prev := state.Load()
-	next := make(state.Map)
-	// Iterate over triggers
-	for _, name := range names {
-		// Get Trigger if available
-		t, ok := tm[name]
-		if !ok {
-			log.Warnf("Could not find trigger %s\n", name)
-			continue
-		}
-		// Run Trigger
-		t.Run(s, prev, next)
+	run(tm, s, names, func(t Trigger) {
+		t.Finish(s)
+	})
+}
+
+// run executes a list of triggers, logging any warnings and calling done for each
+func run(tm Map, s Scope, names []string, done func(t Trigger)) {
+	h := Logged
+	h.Done = done
+	prev, err := state.Load()
+	if err != nil {
+		log.Warnf("Rewriting state file, reason: %s\n", err)
 	}
+	next, _ := Process(context.Background(), tm, s, prev, names, h)
 	if !s.DryRun {
-		// Save new State for next run
-		if err := next.Save(); err != nil {
+		// Save any changes to the State for the next run
+		prev.Merge(next)
+		if err != nil {
+			// Appending after a damaged record would lose the changes
+			err = prev.Save()
+		} else {
+			err = prev.Update(next)
+		}
+		if err != nil {
 			log.Errorf("Failed to save next state file, reason: %s\n", err)
 		}
 	}
 }
+
+// Process detects and executes a list of triggers against the previous state,
+// reporting through the Hooks instead of logging. It returns the changes which
+// were dealt with, to be merged into the next state. Cancelling the context stops processing
+// before the next trigger is executed.
+func Process(ctx context.Context, tm Map, s Scope, prev state.Map, names []string, h Hooks) (next state.Map, err error) {
+	next = make(state.Map)
+	// Decide what to run before running anything
+	decisions := Detect(tm, s, prev, Sort(tm, names, h), h)
+	// What each executed trigger did to its produced files
+	outcomes := make(map[string]Outcome)
+	// Iterate over triggers
+	for _, d := range decisions {
+		if err = ctx.Err(); err != nil {
+			return
+		}
+		// Dependencies may have modified what this trigger checks
+		d.Refresh(s, prev, outcomes, h)
+		t := d.Trigger
+		// Run Trigger
+		if d.Run {
+			o := Outcome{Before: t.Produces.Stat()}
+			before := t.Produces.Fingerprint()
+			t.Execute(s, h)
+			// Failed bins may have left the produced files unwritten
+			o.Changed = t.Status() == Failure || s.DryRun || t.Produces == nil || !before.Equal(t.Produces.Fingerprint())
+			outcomes[t.Name] = o
+			// Only record changes once they are dealt with, so failures are retried
+			if t.Status() != Failure {
+				next.Merge(d.Diff)
+			}
+		} else {
+			// Files regenerated byte-identical need nothing more from this trigger
+			next.Merge(d.Cut)
+		}
+		h.done(t)
+	}
+	return
+}
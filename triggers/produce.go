@@ -0,0 +1,100 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package triggers
+
+import (
+	"crypto/sha256"
+	"github.com/getsolus/usysconf/state"
+	"io"
+	"os"
+	"path/filepath"
+)
+
+// Produce contains the paths generated by executing the configuration.  This
+// supports globbing.
+type Produce struct {
+	Paths []string `toml:"paths"`
+}
+
+// Outcome records what executing a trigger did to its produced files
+type Outcome struct {
+	// Changed is set unless the produced files are known to be byte-identical
+	Changed bool
+	// Before holds the modification times of the produced paths before executing
+	Before state.Map
+}
+
+// Stat records the modification times of the produced paths
+func (p *Produce) Stat() state.Map {
+	if p == nil {
+		return make(state.Map)
+	}
+	m, err := state.Scan(p.Paths)
+	if err != nil {
+		return make(state.Map)
+	}
+	return m
+}
+
+// Fingerprint relates each produced file to a hash of its contents
+type Fingerprint map[string][sha256.Size]byte
+
+// Fingerprint hashes every file found in the produced paths, including the
+// contents of directories.
+func (p *Produce) Fingerprint() Fingerprint {
+	fp := make(Fingerprint)
+	if p == nil {
+		return fp
+	}
+	for _, path := range p.Paths {
+		matches, err := filepath.Glob(path)
+		if err != nil {
+			continue
+		}
+		for _, match := range matches {
+			_ = filepath.Walk(match, func(file string, info os.FileInfo, err error) error {
+				if err != nil || !info.Mode().IsRegular() {
+					return nil
+				}
+				f, err := os.Open(filepath.Clean(file))
+				if err != nil {
+					return nil
+				}
+				h := sha256.New()
+				if _, err = io.Copy(h, f); err == nil {
+					var sum [sha256.Size]byte
+					copy(sum[:], h.Sum(nil))
+					fp[file] = sum
+				}
+				_ = f.Close()
+				return nil
+			})
+		}
+	}
+	return fp
+}
+
+// Equal checks if two Fingerprints describe byte-identical files
+func (fp Fingerprint) Equal(other Fingerprint) bool {
+	if len(fp) != len(other) {
+		return false
+	}
+	for k, v := range fp {
+		if o, ok := other[k]; !ok || o != v {
+			return false
+		}
+	}
+	return true
+}
@@ -16,7 +16,6 @@ package triggers
 
 import (
 	"fmt"
-	log "github.com/DataDrake/waterlog"
 	"github.com/getsolus/usysconf/state"
 	"os"
 )
@@ -28,12 +27,12 @@ type Remove struct {
 }
 
 // Remove glob the paths and if it exists it will remove it from the system
-func (t *Trigger) Remove(s Scope) bool {
+func (t *Trigger) Remove(s Scope, h Hooks) bool {
 	if s.DryRun {
-		log.Debugln("   No Paths will be removed during a dry-run\n")
+		h.debug("    No Paths will be removed during a dry-run")
 	}
 	if t.RemoveDirs == nil {
-		log.Debugln("   No Paths to remove\n")
+		h.debug("    No Paths to remove")
 		return true
 	}
 	m, err := state.Scan(t.RemoveDirs.Paths)
@@ -47,7 +46,7 @@ func (t *Trigger) Remove(s Scope) bool {
 	}
 	m = m.Exclude(t.RemoveDirs.Exclude)
 	for k := range m {
-		log.Debugf("    Removing path '%s'\n", k)
+		h.debug(fmt.Sprintf("    Removing path '%s'", k))
 		if s.DryRun {
 			continue
 		}
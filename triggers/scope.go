@@ -21,4 +21,8 @@ type Scope struct {
 	DryRun bool
 	Forced bool
 	Live   bool
+	// Stamped triggers run even if no changes are detected
+	Stamped bool
+	// Upper is the overlayfs upper layer to limit change detection to, if any
+	Upper string
 }
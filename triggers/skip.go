@@ -32,8 +32,8 @@ func (t *Trigger) ShouldSkip(s Scope, check, diff state.Map) bool {
 	out := Output{
 		Status: Skipped,
 	}
-	// Check if the paths exist, if not skip
-	if check.IsEmpty() || diff.IsEmpty() {
+	// Check if the paths exist, if not skip, unless already known to be dirty
+	if !s.Stamped && (check.IsEmpty() || diff.IsEmpty()) {
 		t.Output = append(t.Output, out)
 		return true
 	}
@@ -0,0 +1,218 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package triggers
+
+import (
+	"crypto/sha256"
+	"encoding/hex"
+	"fmt"
+	log "github.com/DataDrake/waterlog"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+	"syscall"
+)
+
+// claimPrefix starts the name of every claimed stamp, so that claims cannot be
+// mistaken for the hidden temporary files of the tools writing stamps
+const claimPrefix = ".claim."
+
+// Stamps relates the names of triggers to the stamp files which selected them
+type Stamps map[string][]string
+
+// PathHash gets the stamp name for a check path, as written in a trigger
+func PathHash(path string) string {
+	sum := sha256.Sum256([]byte(path))
+	return hex.EncodeToString(sum[:])
+}
+
+// ReadStamps reads the dirty directory once to find the stamped triggers. Each
+// stamp is named after a trigger, or the PathHash of one of its check paths.
+// Hidden files are ignored, so that stamps can be created by renaming them in.
+// When claim is set, each stamp is renamed so new ones are left alone while running.
+func ReadStamps(dir string, tm Map, claim bool) (stamps Stamps, err error) {
+	stamps = make(Stamps)
+	names, err := readNames(dir)
+	if err != nil || len(names) == 0 {
+		return
+	}
+	// Put back the claims of runs which never finished, and read them again
+	if claim && recoverClaims(dir, names) {
+		if names, err = readNames(dir); err != nil {
+			return
+		}
+	}
+	// Only hash check paths when needed
+	var hashes map[string][]string
+	for _, name := range names {
+		if strings.HasPrefix(name, ".") {
+			continue
+		}
+		var targets []string
+		if _, ok := tm[name]; ok {
+			targets = []string{name}
+		} else {
+			if hashes == nil {
+				hashes = tm.pathHashes()
+			}
+			if targets = hashes[name]; len(targets) == 0 {
+				log.Warnf("Could not find trigger for stamp '%s'\n", name)
+				continue
+			}
+		}
+		stamp := name
+		if claim {
+			stamp = fmt.Sprintf("%s%d.%s", claimPrefix, os.Getpid(), name)
+			if err = os.Rename(filepath.Join(dir, name), filepath.Join(dir, stamp)); err != nil {
+				return
+			}
+		}
+		for _, target := range targets {
+			stamps[target] = append(stamps[target], stamp)
+		}
+	}
+	return
+}
+
+// readNames lists the entries of the dirty directory, if it exists
+func readNames(dir string) (names []string, err error) {
+	f, err := os.Open(filepath.Clean(dir))
+	if os.IsNotExist(err) {
+		err = nil
+		return
+	}
+	if err != nil {
+		return
+	}
+	names, err = f.Readdirnames(-1)
+	_ = f.Close()
+	return
+}
+
+// recoverClaims restores the stamps claimed by runs which are no longer running,
+// e.g. after a crash or power loss, reporting if any were found
+func recoverClaims(dir string, names []string) (found bool) {
+	for _, name := range names {
+		orig, pid, ok := parseClaim(name)
+		if !ok || pid == os.Getpid() || syscall.Kill(pid, 0) != syscall.ESRCH {
+			continue
+		}
+		found = true
+		claimed := filepath.Join(dir, name)
+		// Stamps are empty, so an existing one can simply absorb the claim
+		if _, err := os.Stat(filepath.Join(dir, orig)); err == nil {
+			_ = os.Remove(claimed)
+			continue
+		}
+		if err := os.Rename(claimed, filepath.Join(dir, orig)); err != nil {
+			log.Warnf("Failed to restore stamp '%s', reason: %s\n", orig, err)
+		}
+	}
+	return
+}
+
+// parseClaim splits a claimed stamp name (".claim.<pid>.<name>") into its parts
+func parseClaim(name string) (orig string, pid int, ok bool) {
+	if !strings.HasPrefix(name, claimPrefix) {
+		return
+	}
+	rest := strings.TrimPrefix(name, claimPrefix)
+	dot := strings.Index(rest, ".")
+	if dot <= 0 || dot == len(rest)-1 || strings.HasPrefix(rest[dot+1:], ".") {
+		return
+	}
+	pid, err := strconv.Atoi(rest[:dot])
+	if err != nil || pid <= 0 {
+		return
+	}
+	return rest[dot+1:], pid, true
+}
+
+// pathHashes relates the PathHash of each check path to the triggers using it
+func (tm Map) pathHashes() map[string][]string {
+	hashes := make(map[string][]string)
+	for name, t := range tm {
+		if t.Check == nil {
+			continue
+		}
+		for _, path := range t.Check.Paths {
+			hash := PathHash(path)
+			hashes[hash] = append(hashes[hash], name)
+		}
+	}
+	return hashes
+}
+
+// Names gets the sorted names of the stamped triggers
+func (stamps Stamps) Names() []string {
+	var names []string
+	for name := range stamps {
+		names = append(names, name)
+	}
+	sort.Strings(names)
+	return names
+}
+
+// Release removes the claimed stamps once every trigger they selected has run,
+// or puts them back for the next run when any of those triggers failed.
+func (stamps Stamps) Release(dir string, failed map[string]bool) {
+	keep := make(map[string]bool)
+	for name, claimed := range stamps {
+		for _, stamp := range claimed {
+			keep[stamp] = keep[stamp] || failed[name]
+		}
+	}
+	for stamp, k := range keep {
+		name, _, ok := parseClaim(stamp)
+		if !ok {
+			continue
+		}
+		path := filepath.Join(dir, stamp)
+		orig := filepath.Join(dir, name)
+		if k {
+			if err := os.Rename(path, orig); err != nil {
+				log.Warnf("Failed to restore stamp '%s', reason: %s\n", orig, err)
+			}
+			continue
+		}
+		if err := os.Remove(path); err != nil && !os.IsNotExist(err) {
+			log.Warnf("Failed to remove stamp '%s', reason: %s\n", orig, err)
+		}
+	}
+}
+
+// RunStamped executes exactly the triggers stamped in the dirty directory,
+// removing their stamps once they succeed.
+func RunStamped(tm Map, s Scope, dir string) {
+	stamps, err := ReadStamps(dir, tm, !s.DryRun)
+	if err != nil {
+		log.Errorf("Failed to read stamps from '%s', reason: %s\n", dir, err)
+	}
+	if len(stamps) == 0 {
+		log.Debugf("No triggers stamped in '%s'\n", dir)
+		return
+	}
+	s.Stamped = true
+	failed := make(map[string]bool)
+	run(tm, s, stamps.Names(), func(t Trigger) {
+		t.Finish(s)
+		failed[t.Name] = t.Status() == Failure
+	})
+	if !s.DryRun {
+		stamps.Release(dir, failed)
+	}
+}
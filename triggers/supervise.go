@@ -0,0 +1,301 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package triggers
+
+import (
+	"bytes"
+	"fmt"
+	"os"
+	"os/exec"
+	"sync"
+	"syscall"
+)
+
+// sysPidfdOpen is the pidfd_open(2) syscall number, available since Linux 5.3
+const sysPidfdOpen = 434
+
+// buffers holds the output buffers of finished children for reuse
+var buffers = sync.Pool{
+	New: func() interface{} {
+		return new(bytes.Buffer)
+	},
+}
+
+// child is a single running Bin, tracked by its pidfd and output pipe
+type child struct {
+	index   int
+	pid     int
+	pidfd   int
+	pipe    int
+	buff    *bytes.Buffer
+	status  syscall.WaitStatus
+	exited  bool
+	drained bool
+}
+
+// pidfdOpen gets a file descriptor referring to a process
+func pidfdOpen(pid int) (int, error) {
+	fd, _, errno := syscall.Syscall(sysPidfdOpen, uintptr(pid), 0, 0)
+	if errno != 0 {
+		return -1, errno
+	}
+	return int(fd), nil
+}
+
+// Supervise executes the bins with no more than limit children at once. Instead of
+// waiting on each child separately, their exits and output are all handled from a
+// single epoll loop. An error is returned if supervision isn't supported, before
+// anything is executed.
+func Supervise(bins []Bin, env map[string]string, limit int) (outs []Output, err error) {
+	// Make sure that pidfds are available
+	fd, err := pidfdOpen(os.Getpid())
+	if err != nil {
+		err = fmt.Errorf("pidfd_open unavailable: %s", err)
+		return
+	}
+	_ = syscall.Close(fd)
+	epfd, err := syscall.EpollCreate1(syscall.EPOLL_CLOEXEC)
+	if err != nil {
+		return
+	}
+	null, err := os.Open(os.DevNull)
+	if err != nil {
+		_ = syscall.Close(epfd)
+		return
+	}
+	// Setup environment, inheriting it unless one is specified
+	environ := os.Environ()
+	if len(env) > 0 {
+		environ = nil
+		for k, v := range env {
+			environ = append(environ, fmt.Sprintf("%s=%s", k, v))
+		}
+	}
+	outs, err = supervise(epfd, bins, environ, null, limit)
+	_ = null.Close()
+	_ = syscall.Close(epfd)
+	return
+}
+
+// supervise is the epoll loop of Supervise
+func supervise(epfd int, bins []Bin, environ []string, null *os.File, limit int) (outs []Output, err error) {
+	outs = make([]Output, len(bins))
+	children := make(map[int32]*child)
+	events := make([]syscall.EpollEvent, 64)
+	chunk := make([]byte, 32*1024)
+	next, running := 0, 0
+	for next < len(bins) || running > 0 {
+		// Start as many children as allowed
+		for running < limit && next < len(bins) {
+			c, err := spawn(&bins[next], environ, null)
+			if err == nil {
+				c.index = next
+				err = c.watch(epfd, children)
+			}
+			if err != nil {
+				outs[next] = failed(&bins[next], err)
+				next++
+				continue
+			}
+			next++
+			running++
+		}
+		if running == 0 {
+			continue
+		}
+		n, err := syscall.EpollWait(epfd, events, -1)
+		if err == syscall.EINTR {
+			continue
+		}
+		if err != nil {
+			// Don't leave anything running or unreported
+			for _, c := range children {
+				if c.buff != nil {
+					outs[c.index] = failed(&bins[c.index], err)
+					c.abort(epfd, children)
+				}
+			}
+			for ; next < len(bins); next++ {
+				outs[next] = failed(&bins[next], err)
+			}
+			return outs, err
+		}
+		for _, ev := range events[:n] {
+			c, ok := children[ev.Fd]
+			if !ok {
+				continue
+			}
+			fd := int(ev.Fd)
+			if fd == c.pipe {
+				c.drain(chunk)
+				if !c.drained {
+					continue
+				}
+				c.pipe = -1
+			} else {
+				c.reap()
+				if !c.exited {
+					continue
+				}
+				c.pidfd = -1
+			}
+			// Stop watching whichever side is done
+			_ = syscall.EpollCtl(epfd, syscall.EPOLL_CTL_DEL, fd, nil)
+			_ = syscall.Close(fd)
+			delete(children, ev.Fd)
+			if !(c.drained && c.exited) {
+				continue
+			}
+			outs[c.index] = c.finish(&bins[c.index])
+			running--
+		}
+	}
+	return
+}
+
+// failed creates the Output for a Bin which could not be supervised
+func failed(b *Bin, err error) Output {
+	return Output{
+		Status:  Failure,
+		Message: fmt.Sprintf("error executing '%s %v': %s\n", b.Bin, b.Args, err),
+	}
+}
+
+// watch registers the pidfd and pipe of a child with epoll, or stops the child
+// if that isn't possible
+func (c *child) watch(epfd int, children map[int32]*child) error {
+	for _, fd := range []int{c.pidfd, c.pipe} {
+		ev := syscall.EpollEvent{Events: syscall.EPOLLIN, Fd: int32(fd)}
+		if err := syscall.EpollCtl(epfd, syscall.EPOLL_CTL_ADD, fd, &ev); err != nil {
+			c.abort(epfd, children)
+			return err
+		}
+		children[int32(fd)] = c
+	}
+	return nil
+}
+
+// abort kills and reaps a child, and closes whatever it still has open
+func (c *child) abort(epfd int, children map[int32]*child) {
+	// Once reaped, the pid may already belong to something else
+	if !c.exited {
+		_ = syscall.Kill(c.pid, syscall.SIGKILL)
+		_, _ = syscall.Wait4(c.pid, nil, 0, nil)
+	}
+	for _, fd := range []int{c.pidfd, c.pipe} {
+		if fd < 0 {
+			continue
+		}
+		if _, ok := children[int32(fd)]; ok {
+			_ = syscall.EpollCtl(epfd, syscall.EPOLL_CTL_DEL, fd, nil)
+			delete(children, int32(fd))
+		}
+		_ = syscall.Close(fd)
+	}
+	c.pidfd, c.pipe = -1, -1
+	c.release()
+}
+
+// spawn starts a single Bin with its output going to a non-blocking pipe
+func spawn(b *Bin, environ []string, null *os.File) (c *child, err error) {
+	path, err := exec.LookPath(b.Bin)
+	if err != nil {
+		return
+	}
+	var fds [2]int
+	if err = syscall.Pipe2(fds[:], syscall.O_CLOEXEC); err != nil {
+		return
+	}
+	w := os.NewFile(uintptr(fds[1]), "pipe")
+	attr := &os.ProcAttr{
+		Env:   environ,
+		Files: []*os.File{null, w, w},
+	}
+	p, err := os.StartProcess(path, append([]string{b.Bin}, b.Args...), attr)
+	_ = w.Close()
+	if err != nil {
+		_ = syscall.Close(fds[0])
+		return
+	}
+	c = &child{
+		pid:  p.Pid,
+		pipe: fds[0],
+		buff: buffers.Get().(*bytes.Buffer),
+	}
+	// The child is reaped through its pidfd instead
+	_ = p.Release()
+	if err = syscall.SetNonblock(c.pipe, true); err == nil {
+		c.pidfd, err = pidfdOpen(c.pid)
+	}
+	if err != nil {
+		_ = syscall.Kill(c.pid, syscall.SIGKILL)
+		_, _ = syscall.Wait4(c.pid, nil, 0, nil)
+		_ = syscall.Close(c.pipe)
+		c.release()
+		c = nil
+	}
+	return
+}
+
+// drain reads all of the output currently available from the pipe
+func (c *child) drain(chunk []byte) {
+	for {
+		n, err := syscall.Read(c.pipe, chunk)
+		if n > 0 {
+			c.buff.Write(chunk[:n])
+			continue
+		}
+		if err == syscall.EINTR {
+			continue
+		}
+		if err == nil || err != syscall.EAGAIN {
+			c.drained = true
+		}
+		return
+	}
+}
+
+// reap collects the exit status once the pidfd reports the child as finished
+func (c *child) reap() {
+	pid, err := syscall.Wait4(c.pid, &c.status, syscall.WNOHANG, nil)
+	if pid == c.pid || err == syscall.ECHILD {
+		c.exited = true
+	}
+}
+
+// finish converts the exit status of the child into an Output
+func (c *child) finish(b *Bin) Output {
+	defer c.release()
+	out := Output{Status: Success}
+	var reason string
+	switch {
+	case c.status.Exited() && c.status.ExitStatus() == 0:
+		return out
+	case c.status.Signaled():
+		reason = "signal: " + c.status.Signal().String()
+	default:
+		reason = fmt.Sprintf("exit status %d", c.status.ExitStatus())
+	}
+	out.Status = Failure
+	out.Message = fmt.Sprintf("error executing '%s %v': %s\n%s", b.Bin, b.Args, reason, c.buff.String())
+	return out
+}
+
+// release returns the output buffer for reuse
+func (c *child) release() {
+	c.buff.Reset()
+	buffers.Put(c.buff)
+	c.buff = nil
+}
@@ -32,46 +32,75 @@ type Trigger struct {
 	Check       *Check            `toml:"check,omitempty"`
 	Env         map[string]string `toml:"env"`
 	RemoveDirs  *Remove           `toml:"remove,omitempty"`
+	Produces    *Produce          `toml:"produces,omitempty"`
+	Deps        []string          `toml:"deps"`
 }
 
-// Run will process a single configuration and scope.
-func (t *Trigger) Run(s Scope, prev, next state.Map) (ok bool) {
-	var check, diff state.Map
+// Detect performs the read-only checks for a single configuration and scope,
+// reporting the changes found and whether the trigger should be executed.
+func (t *Trigger) Detect(s Scope, prev state.Map, h Hooks) (diff state.Map, run, ok bool) {
+	diff, _, run, ok = t.detect(s, prev, nil, h)
+	return
+}
+
+// detect works like Detect, but does not count changes to the clean paths whose
+// modification times were already recorded in the previous state. Those changes
+// are reported separately as cut.
+func (t *Trigger) detect(s Scope, prev state.Map, clean state.Map, h Hooks) (diff, cut state.Map, run, ok bool) {
+	var check, changes state.Map
 	// Get the new check result
-	check, ok = t.CheckMatch()
+	check, ok = t.CheckMatch(s, h)
 	if !ok {
-		goto FINISH
+		return
 	}
 	// Calculate Diff
 	diff = state.Diff(prev, check)
-	// Merge it into the new State
-	next.Merge(diff)
-	// Check for Skip
-	if t.ShouldSkip(s, check, diff) {
-		goto FINISH
+	// Ignore files which were regenerated byte-identical
+	changes = diff
+	if len(clean) > 0 {
+		changes = make(state.Map)
+		changes.Merge(diff)
+		for k := range diff {
+			if before, ok := clean[k]; ok && before.Equal(prev[k]) {
+				delete(changes, k)
+				if cut == nil {
+					cut = make(state.Map)
+				}
+				cut[k] = diff[k]
+			}
+		}
 	}
+	// Check for Skip
+	run = !t.ShouldSkip(s, check, changes)
+	return
+}
+
+// Execute carries out the removals and bins for a configuration that was not skipped.
+func (t *Trigger) Execute(s Scope, h Hooks) (ok bool) {
 	// Do the removals
-	if ok = t.Remove(s); !ok {
-		goto FINISH
+	if ok = t.Remove(s, h); !ok {
+		return
 	}
 	// Run the bins
-	t.ExecuteBins(s)
-FINISH:
-	t.Finish(s)
+	t.ExecuteBins(s, h)
 	return
 }
 
-// Finish is the last function to be executed by any trigger to output details to the user.
-func (t *Trigger) Finish(s Scope) {
-	// Check for the worst status
+// Status finds the worst status out of all of the Output
+func (t *Trigger) Status() Status {
 	status := Skipped
 	for _, out := range t.Output {
 		if out.Status > status {
 			status = out.Status
 		}
 	}
+	return status
+}
+
+// Finish is the last function to be executed by any trigger to output details to the user.
+func (t *Trigger) Finish(s Scope) {
 	// Indicate the worst status for the whole group
-	switch status {
+	switch t.Status() {
 	case Skipped:
 		log.Debugln(t.Name)
 	case Failure:
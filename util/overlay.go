@@ -0,0 +1,115 @@
+// Copyright © 2019-2020 Solus Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package util
+
+import (
+	log "github.com/DataDrake/waterlog"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"strconv"
+	"strings"
+)
+
+// OverlayUpperDir finds the upper layer of an overlayfs mounted on "/", if any
+//
+// The upperdir is only returned when it is reachable from this process, which
+// is not the case for most container runtimes that keep it on the host.
+func OverlayUpperDir() (upper string, ok bool) {
+	raw, err := ioutil.ReadFile("/proc/self/mountinfo")
+	if err != nil {
+		log.Debugf("Failed to read '/proc/self/mountinfo', reason: %s\n", err)
+		return
+	}
+	for _, line := range strings.Split(string(raw), "\n") {
+		// <id> <parent> <major:minor> <root> <mount point> <options> [<optional>...] - <fstype> <source> <super options>
+		sep := strings.Index(line, " - ")
+		if sep < 0 {
+			continue
+		}
+		pre := strings.Fields(line[:sep])
+		post := strings.Fields(line[sep+3:])
+		if len(pre) < 5 || len(post) < 3 {
+			continue
+		}
+		if unescapeMount(pre[4]) != "/" {
+			continue
+		}
+		// Later mounts on "/" stack on top of earlier ones
+		upper = ""
+		if post[0] != "overlay" {
+			continue
+		}
+		for _, opt := range splitOverlayOpts(post[2]) {
+			if strings.HasPrefix(opt, "upperdir=") {
+				upper = unescapeMount(strings.TrimPrefix(opt, "upperdir="))
+			}
+		}
+	}
+	if len(upper) == 0 {
+		return
+	}
+	upper = filepath.Clean(upper)
+	info, err := os.Stat(upper)
+	if err != nil || !info.IsDir() {
+		log.Debugf("Overlayfs upperdir '%s' is not accessible, scanning merged view\n", upper)
+		upper = ""
+		return
+	}
+	log.Debugf("Overlayfs upperdir '%s' found for '/'\n", upper)
+	ok = true
+	return
+}
+
+// splitOverlayOpts splits overlayfs super options on commas, honouring backslash escapes
+func splitOverlayOpts(opts string) (split []string) {
+	var curr strings.Builder
+	for i := 0; i < len(opts); i++ {
+		switch opts[i] {
+		case '\\':
+			if i+1 < len(opts) && opts[i+1] == ',' {
+				curr.WriteByte(',')
+				i++
+				continue
+			}
+			curr.WriteByte(opts[i])
+		case ',':
+			split = append(split, curr.String())
+			curr.Reset()
+		default:
+			curr.WriteByte(opts[i])
+		}
+	}
+	return append(split, curr.String())
+}
+
+// unescapeMount decodes the octal escapes (e.g. "\040") used in mountinfo fields
+func unescapeMount(field string) string {
+	if !strings.Contains(field, "\\") {
+		return field
+	}
+	var out strings.Builder
+	for i := 0; i < len(field); i++ {
+		if field[i] == '\\' && i+3 < len(field) {
+			if c, err := strconv.ParseUint(field[i+1:i+4], 8, 8); err == nil {
+				out.WriteByte(byte(c))
+				i += 3
+				continue
+			}
+		}
+		out.WriteByte(field[i])
+	}
+	return out.String()
+}